@@ -10,7 +10,7 @@ var bytes = require('bytes');
 if (!argv.iterations || !argv.concurrency) {
   console.error('Please provide desired iterations and concurrency');
   console.error('Example: \n\tnode bench/bench-batch.js --iterations 50 --concurrency 10');
-  console.error('Optional args: \n\t--mem (reports memory stats)');
+  console.error('Optional args: \n\t--mem (reports memory stats)\n\t--adaptive (shave with the adaptive filter order)');
   process.exit(1);
 }
 
@@ -50,6 +50,7 @@ var start = function(files){
     var options = {
       zoom: 13,
       filters: filters,
+      adaptive: argv.adaptive ? true : false,
       compress: {
         type: argv.compress
       }
@@ -121,7 +122,7 @@ var start = function(files){
         }
       }
 
-      console.log("Benchmark iterations:",argv.iterations,"concurrency:",argv.concurrency);
+      console.log("Benchmark iterations:",argv.iterations,"concurrency:",argv.concurrency,"adaptive:",options.adaptive);
       var min_rate = 1000;
       if (process.platform === 'darwin' && process.env.TRAVIS !== undefined) {
         min_rate = 1300;
@@ -87,6 +87,7 @@
         './src/vtshaver.cpp',
         './src/shave.cpp',
         './src/filters.cpp',
+        './src/adaptive_filter.cpp',
         './mason_packages/.link/src/mbgl/tile/geometry_tile_data.cpp',
         './mason_packages/.link/platform/default/src/mbgl/layermanager/layer_manager.cpp',
         # mbgl::LayerManager::annotationsEnabled
@@ -0,0 +1,209 @@
+#include "adaptive_filter.hpp"
+
+#include <algorithm>
+#include <mbgl/style/expression/value.hpp>
+#include <string>
+#include <utility>
+
+constexpr AdaptiveFilter::counter_type AdaptiveFilter::reorder_interval;
+
+namespace {
+
+using mbgl::style::expression::EvaluationResult;
+using mbgl::style::expression::Expression;
+
+bool is_true(EvaluationResult const& result) {
+    auto const typed = mbgl::style::expression::fromExpressionValue<bool>(*result);
+    return typed && *typed;
+}
+
+// Conservatively decide whether evaluating an expression can return an error.
+// Only operators that never fail at runtime are trusted; anything else, including the
+// type assertions the expression parser inserts around `get` for ordering comparisons
+// (e.g. ["<", ["get", "rank"], 5]), makes the whole branch fallible.
+bool can_error(Expression const& expression) {
+    std::string const op = expression.getOperator();
+    // All legacy filters convert to "filter-*" compound expressions, which never fail
+    bool safe = op.compare(0, 7, "filter-") == 0 ||
+                op == "literal" || op == "any" || op == "all" || op == "!" ||
+                op == "==" || op == "!=" || op == "get" || op == "has" ||
+                op == "zoom" || op == "geometry-type" || op == "id" || op == "properties" ||
+                op == "case" || op == "match" || op == "coalesce";
+    expression.eachChild([&](Expression const& child) {
+        if (safe && can_error(child)) {
+            safe = false;
+        }
+    });
+    return !safe;
+}
+
+} // namespace
+
+AdaptiveFilter::AdaptiveFilter(mbgl::style::Filter filter)
+    : filter_(std::move(filter)) {
+    if (!filter_.expression) {
+        return;
+    }
+    Expression const& root = **filter_.expression;
+    std::string const op = root.getOperator();
+    if (op != "any" && op != "all") {
+        return;
+    }
+    kind_ = op == "any" ? kind_type::any : kind_type::all;
+    root.eachChild([&](Expression const& child) {
+        branches_.push_back(&child);
+        infallible_.push_back(can_error(child) ? 0 : 1);
+    });
+    std::vector<branch_stats>(branches_.size()).swap(branch_stats_);
+}
+
+std::vector<std::size_t> AdaptiveFilter::order() const {
+    std::vector<std::size_t> current(branches_.size());
+    std::vector<counter_type> const none(branches_.size(), 0);
+    sort_order(&current, none, none);
+    return current;
+}
+
+// `any` wants the branches most likely to match first, `all` the ones most likely to fail.
+// The hit rate is smoothed so branches that were never evaluated sort to the middle, and
+// ties keep their style order. `all` can be evaluated in any order, but `any` only moves a
+// branch ahead of infallible branches: each fallible branch is placed before every branch
+// that follows it in style order, see evaluate_any() for why.
+void AdaptiveFilter::sort_order(std::vector<std::size_t>* order,
+                                std::vector<counter_type> const& local_evaluations,
+                                std::vector<counter_type> const& local_hits) const {
+    std::size_t const count = branches_.size();
+    std::vector<double> rates(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const evaluations = branch_stats_[i].evaluations.load(std::memory_order_relaxed) + local_evaluations[i];
+        auto const hits = branch_stats_[i].hits.load(std::memory_order_relaxed) + local_hits[i];
+        rates[i] = (static_cast<double>(hits) + 1.0) / (static_cast<double>(evaluations) + 2.0);
+    }
+    std::vector<char> placed(count, 0);
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        std::size_t candidates = count;
+        if (kind_ == kind_type::any) {
+            // nothing after the first fallible branch that is not placed yet can go before it
+            for (std::size_t i = 0; i < count; ++i) {
+                if (placed[i] == 0 && infallible_[i] == 0) {
+                    candidates = i + 1;
+                    break;
+                }
+            }
+        }
+        std::size_t best = count;
+        for (std::size_t i = 0; i < candidates; ++i) {
+            if (placed[i] != 0) {
+                continue;
+            }
+            if (best == count ||
+                (kind_ == kind_type::any && rates[i] > rates[best]) ||
+                (kind_ == kind_type::all && rates[i] < rates[best])) {
+                best = i;
+            }
+        }
+        placed[best] = 1;
+        (*order)[slot] = best;
+    }
+}
+
+AdaptiveFilter::Pass::Pass(AdaptiveFilter* filter)
+    : filter_(filter),
+      order_(filter->branches_.size()),
+      position_(filter->branches_.size()),
+      evaluations_(filter->branches_.size(), 0),
+      hits_(filter->branches_.size(), 0) {
+    reorder();
+}
+
+AdaptiveFilter::Pass::~Pass() {
+    filter_->evaluations_.fetch_add(filter_evaluations_, std::memory_order_relaxed);
+    filter_->hits_.fetch_add(filter_hits_, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < evaluations_.size(); ++i) {
+        filter_->branch_stats_[i].evaluations.fetch_add(evaluations_[i], std::memory_order_relaxed);
+        filter_->branch_stats_[i].hits.fetch_add(hits_[i], std::memory_order_relaxed);
+    }
+}
+
+void AdaptiveFilter::Pass::reorder() {
+    filter_->sort_order(&order_, evaluations_, hits_);
+    for (std::size_t pos = 0; pos < order_.size(); ++pos) {
+        position_[order_[pos]] = pos;
+    }
+}
+
+bool AdaptiveFilter::Pass::operator()(mbgl::style::expression::EvaluationContext const& context) {
+    if (filter_->kind_ != kind_type::single && filter_evaluations_ > 0 && filter_evaluations_ % reorder_interval == 0) {
+        reorder();
+    }
+    ++filter_evaluations_;
+
+    bool matched = false;
+    switch (filter_->kind_) {
+    case kind_type::any:
+        matched = evaluate_any(context);
+        break;
+    case kind_type::all:
+        matched = evaluate_all(context);
+        break;
+    default:
+        matched = filter_->filter_(context);
+        break;
+    }
+    if (matched) {
+        ++filter_hits_;
+    }
+    return matched;
+}
+
+// mbgl's `any` returns the first error or true it meets in style order, and the filter
+// turns an error into false. Since sort_order() only moves a branch ahead of infallible
+// branches, every branch skipped so far that comes earlier in style order can only be
+// true or false. So a matching branch decides the result on its own.
+bool AdaptiveFilter::Pass::evaluate_any(mbgl::style::expression::EvaluationContext const& context) {
+    for (auto const idx : order_) {
+        EvaluationResult const result = filter_->branches_[idx]->evaluate(context);
+        ++evaluations_[idx];
+        if (!result) {
+            return evaluate_any_before(idx, context);
+        }
+        if (is_true(result)) {
+            ++hits_[idx];
+            return true;
+        }
+    }
+    return false;
+}
+
+// When a branch fails, mbgl's result depends only on the branches before it in style order.
+// The ones evaluated already were false, the rest are infallible, so it is true exactly when
+// one of those is true.
+bool AdaptiveFilter::Pass::evaluate_any_before(std::size_t failed, mbgl::style::expression::EvaluationContext const& context) {
+    std::size_t const failed_position = position_[failed];
+    for (std::size_t prev = 0; prev < failed; ++prev) {
+        if (position_[prev] < failed_position) {
+            continue;
+        }
+        EvaluationResult const result = filter_->branches_[prev]->evaluate(context);
+        ++evaluations_[prev];
+        if (result && is_true(result)) {
+            ++hits_[prev];
+            return true;
+        }
+    }
+    return false;
+}
+
+// mbgl's `all` returns false or an error as soon as a branch is not true, and the
+// filter turns both into false, so any evaluation order gives the same result.
+bool AdaptiveFilter::Pass::evaluate_all(mbgl::style::expression::EvaluationContext const& context) {
+    for (auto const idx : order_) {
+        EvaluationResult const result = filter_->branches_[idx]->evaluate(context);
+        ++evaluations_[idx];
+        if (!result || !is_true(result)) {
+            return false;
+        }
+        ++hits_[idx];
+    }
+    return true;
+}
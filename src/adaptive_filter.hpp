@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mbgl/style/expression/expression.hpp>
+#include <mbgl/style/filter.hpp>
+#include <vector>
+
+// Evaluates a filter exactly like mbgl::style::Filter::operator() does, but when the
+// filter is a top-level `any` or `all` (like the merged filters from styleToFilters.js)
+// its branches are evaluated in an order that adapts to how often each branch matches.
+// The hit counts are shared by every shave using this filter, so this class is
+// non-copyable and lives behind a shared_ptr.
+class AdaptiveFilter {
+  public:
+    using counter_type = std::uint64_t;
+    enum class kind_type { single,
+                           any,
+                           all };
+
+    // Every evaluation of a branch is counted, and hits are the evaluations that returned true
+    struct branch_stats {
+        std::atomic<counter_type> evaluations{0};
+        std::atomic<counter_type> hits{0};
+    };
+
+    // Evaluates the filter for all features of one layer in one tile. Counts are kept
+    // locally and merged into the shared stats when the pass is destroyed.
+    class Pass {
+      public:
+        explicit Pass(AdaptiveFilter* filter);
+        ~Pass();
+        Pass(Pass const&) = delete;
+        Pass& operator=(Pass const&) = delete;
+        Pass(Pass&&) = delete;
+        Pass& operator=(Pass&&) = delete;
+
+        bool operator()(mbgl::style::expression::EvaluationContext const& context);
+
+      private:
+        void reorder();
+        bool evaluate_any(mbgl::style::expression::EvaluationContext const& context);
+        bool evaluate_any_before(std::size_t failed, mbgl::style::expression::EvaluationContext const& context);
+        bool evaluate_all(mbgl::style::expression::EvaluationContext const& context);
+
+        AdaptiveFilter* filter_;
+        std::vector<std::size_t> order_;
+        // Inverse of order_: the position each branch is evaluated at
+        std::vector<std::size_t> position_;
+        std::vector<counter_type> evaluations_;
+        std::vector<counter_type> hits_;
+        counter_type filter_evaluations_ = 0;
+        counter_type filter_hits_ = 0;
+    };
+
+    explicit AdaptiveFilter(mbgl::style::Filter filter);
+    AdaptiveFilter(AdaptiveFilter const&) = delete;
+    AdaptiveFilter& operator=(AdaptiveFilter const&) = delete;
+    AdaptiveFilter(AdaptiveFilter&&) = delete;
+    AdaptiveFilter& operator=(AdaptiveFilter&&) = delete;
+    ~AdaptiveFilter() = default;
+
+    kind_type kind() const {
+        return kind_;
+    }
+    counter_type evaluations() const {
+        return evaluations_.load(std::memory_order_relaxed);
+    }
+    counter_type hits() const {
+        return hits_.load(std::memory_order_relaxed);
+    }
+    std::vector<branch_stats> const& branches() const {
+        return branch_stats_;
+    }
+    // The order branches are currently evaluated in, as indexes into branches()
+    std::vector<std::size_t> order() const;
+
+    // Re-sort the branches after this many evaluations within a single pass
+    static constexpr counter_type reorder_interval = 256;
+
+  private:
+    void sort_order(std::vector<std::size_t>* order,
+                    std::vector<counter_type> const& local_evaluations,
+                    std::vector<counter_type> const& local_hits) const;
+
+    mbgl::style::Filter filter_;
+    kind_type kind_ = kind_type::single;
+    // Children of the top-level `any`/`all`, owned by filter_.expression
+    std::vector<mbgl::style::expression::Expression const*> branches_;
+    // Whether a branch can never return an evaluation error, see can_error() in adaptive_filter.cpp
+    std::vector<char> infallible_;
+    std::vector<branch_stats> branch_stats_;
+    std::atomic<counter_type> evaluations_{0};
+    std::atomic<counter_type> hits_{0};
+};
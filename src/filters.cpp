@@ -11,13 +11,125 @@
 Napi::FunctionReference Filters::constructor; // NOLINT
 
 Napi::Object Filters::Initialize(Napi::Env env, Napi::Object exports) {
-    Napi::Function func = DefineClass(env, "Filters", {InstanceMethod<&Filters::layers>("layers")});
+    Napi::Function func = DefineClass(env, "Filters", {InstanceMethod<&Filters::layers>("layers"),
+                                                       InstanceMethod<&Filters::setLayer>("setLayer"),
+                                                       InstanceMethod<&Filters::removeLayer>("removeLayer"),
+                                                       InstanceMethod<&Filters::stats>("stats")});
     constructor = Napi::Persistent(func);
     constructor.SuppressDestruct();
     exports.Set("Filters", func);
     return exports;
 }
 
+// Shared by the constructor and `setLayer` so both validate a layer object the same way
+bool Filters::parse_layer(Napi::Env env, Napi::Value const& layer_val, filter_values_type* filter_values) {
+    if (!layer_val.IsObject() || layer_val.IsNull() || layer_val.IsUndefined()) {
+        Napi::Error::New(env, "layer must be an object and cannot be null or undefined").ThrowAsJavaScriptException();
+        return false;
+    }
+    auto layer = layer_val.As<Napi::Object>();
+
+    // set default 0/22 for min/max zooms
+    // if they exist in the filter object, update the values here
+    zoom_type minzoom = 0;
+    zoom_type maxzoom = 22;
+    if (layer.Has("minzoom")) {
+        Napi::Value minzoom_val = layer.Get("minzoom");
+        if (!minzoom_val.IsNumber() || minzoom_val.As<Napi::Number>().DoubleValue() < 0) {
+            Napi::Error::New(env, "Value for 'minzoom' must be a positive number.").ThrowAsJavaScriptException();
+            return false;
+        }
+        minzoom = minzoom_val.As<Napi::Number>().DoubleValue();
+    } else {
+        Napi::Error::New(env, "Filter must include a minzoom property.").ThrowAsJavaScriptException();
+        return false;
+    }
+    if (layer.Has("maxzoom")) {
+        Napi::Value maxzoom_val = layer.Get("maxzoom");
+        if (!maxzoom_val.IsNumber() || maxzoom_val.As<Napi::Number>().DoubleValue() < 0) {
+            Napi::Error::New(env, "Value for 'maxzoom' must be a positive number.").ThrowAsJavaScriptException();
+            return false;
+        }
+        maxzoom = maxzoom_val.As<Napi::Number>().DoubleValue();
+    } else {
+        Napi::Error::New(env, "Filter must include a maxzoom property.").ThrowAsJavaScriptException();
+        return false;
+    }
+    // handle filters array
+    const Napi::Value layer_filter = layer.Get("filters");
+    // error handling in case filter value passed in from JS-world is somehow invalid
+    if (layer_filter.IsNull() || layer_filter.IsUndefined()) {
+        Napi::Error::New(env, "Filters is not properly constructed.").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    // Convert each filter array to an mbgl::style::Filter object
+    mbgl::style::Filter filter;
+
+    // NOTICE: If a layer is styled, but does not have a filter, the filter value will equal
+    // true (see logic within lib/styleToFilters.js)
+    // Ex: { water: true }
+    // Because of this, we check for if the filter is an array or a boolean before converting to a mbgl Filter
+    // If a boolean and is true, create a null/empty Filter object.
+    Napi::Object json = env.Global().Get("JSON").As<Napi::Object>();
+    Napi::Function stringify = json.Get("stringify").As<Napi::Function>();
+
+    if (layer_filter.IsArray()) {
+        mbgl::style::conversion::Error filterError;
+        std::string filter_str = stringify.Call(json, {layer_filter}).As<Napi::String>();
+        auto optional_filter = mbgl::style::conversion::convertJSON<mbgl::style::Filter>(filter_str, filterError);
+        if (!optional_filter) {
+            if (filterError.message == "filter property must be a string") {
+                Napi::TypeError::New(env, "Unable to create Filter object, ensure all filters are expression-based").ThrowAsJavaScriptException();
+
+            } else {
+                Napi::TypeError::New(env, filterError.message.c_str()).ThrowAsJavaScriptException();
+            }
+            return false;
+        }
+        filter = *optional_filter;
+    } else if (layer_filter.IsBoolean() && layer_filter.As<Napi::Boolean>()) {
+        filter = mbgl::style::Filter{};
+    } else {
+        Napi::TypeError::New(env, "invalid filter value, must be an array or a boolean").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Value const layer_properties = layer.Get("properties");
+    if (layer_properties.IsNull() || layer_properties.IsUndefined()) {
+        Napi::Error::New(env, "Property-Filters is not properly constructed.").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    // NOTICE: If a layer is styled, but does not have a property, the property value will equal []
+    // NOTICE: If a property is true, that means we need to keep all the properties
+    filter_properties_type property;
+    if (layer_properties.IsArray()) {
+        auto propertyArray = layer_properties.As<Napi::Array>();
+        std::uint32_t propertiesLength = propertyArray.Length();
+        std::vector<std::string> values;
+        values.reserve(propertiesLength);
+        for (std::uint32_t index = 0; index < propertiesLength; ++index) {
+            Napi::Value property_value = propertyArray.Get(index);
+            std::string value = property_value.As<Napi::String>();
+            if (!value.empty()) {
+                values.emplace_back(value);
+            }
+        }
+        property.first = list;
+        property.second = values;
+    } else if (layer_properties.IsBoolean() && layer_properties.As<Napi::Boolean>()) {
+        property.first = all;
+        property.second = {};
+    } else {
+        Napi::TypeError::New(env, "invalid filter value, must be an array or a boolean").ThrowAsJavaScriptException();
+        return false;
+    }
+    auto adaptive_filter = std::make_shared<AdaptiveFilter>(filter);
+    *filter_values = std::make_tuple(std::move(filter), std::move(property), minzoom, maxzoom, std::move(adaptive_filter));
+    return true;
+}
+
 /**
  * Takes optimized filter object from shaver.styleToFilters and returns c++ filters for shave.
  * @class Filters
@@ -43,6 +155,7 @@ Filters::Filters(Napi::CallbackInfo const& info)
             }
             Napi::Object filters_obj = filters_val.As<Napi::Object>();
             Napi::Array layers = filters_obj.GetPropertyNames();
+            filters_type filters;
             // Loop through each layer in the object and convert its filter to a mbgl::style::Filter
             std::uint32_t length = layers.Length();
             for (std::uint32_t i = 0; i < length; ++i) {
@@ -52,113 +165,13 @@ Filters::Filters(Napi::CallbackInfo const& info)
                     return;
                 }
 
-                Napi::Value layer_val = filters_obj.Get(layer_key);
-
-                if (!layer_val.IsObject() || layer_val.IsNull() || layer_val.IsUndefined()) {
-                    Napi::Error::New(env, "layer must be an object and cannot be null or undefined").ThrowAsJavaScriptException();
-                    return;
-                }
-                auto layer = layer_val.As<Napi::Object>();
-
-                // set default 0/22 for min/max zooms
-                // if they exist in the filter object, update the values here
-                zoom_type minzoom = 0;
-                zoom_type maxzoom = 22;
-                if (layer.Has("minzoom")) {
-                    Napi::Value minzoom_val = layer.Get("minzoom");
-                    if (!minzoom_val.IsNumber() || minzoom_val.As<Napi::Number>().DoubleValue() < 0) {
-                        Napi::Error::New(env, "Value for 'minzoom' must be a positive number.").ThrowAsJavaScriptException();
-                        return;
-                    }
-                    minzoom = minzoom_val.As<Napi::Number>().DoubleValue();
-                } else {
-                    Napi::Error::New(env, "Filter must include a minzoom property.").ThrowAsJavaScriptException();
-                    return;
-                }
-                if (layer.Has("maxzoom")) {
-                    Napi::Value maxzoom_val = layer.Get("maxzoom");
-                    if (!maxzoom_val.IsNumber() || maxzoom_val.As<Napi::Number>().DoubleValue() < 0) {
-                        Napi::Error::New(env, "Value for 'maxzoom' must be a positive number.").ThrowAsJavaScriptException();
-                        return;
-                    }
-                    maxzoom = maxzoom_val.As<Napi::Number>().DoubleValue();
-                } else {
-                    Napi::Error::New(env, "Filter must include a maxzoom property.").ThrowAsJavaScriptException();
-                    return;
-                }
-                // handle filters array
-                const Napi::Value layer_filter = layer.Get("filters");
-                // error handling in case filter value passed in from JS-world is somehow invalid
-                if (layer_filter.IsNull() || layer_filter.IsUndefined()) {
-                    Napi::Error::New(env, "Filters is not properly constructed.").ThrowAsJavaScriptException();
-                    return;
-                }
-
-                // Convert each filter array to an mbgl::style::Filter object
-                mbgl::style::Filter filter;
-
-                // NOTICE: If a layer is styled, but does not have a filter, the filter value will equal
-                // true (see logic within lib/styleToFilters.js)
-                // Ex: { water: true }
-                // Because of this, we check for if the filter is an array or a boolean before converting to a mbgl Filter
-                // If a boolean and is true, create a null/empty Filter object.
-                Napi::Object json = env.Global().Get("JSON").As<Napi::Object>();
-                Napi::Function stringify = json.Get("stringify").As<Napi::Function>();
-
-                if (layer_filter.IsArray()) {
-                    mbgl::style::conversion::Error filterError;
-                    std::string filter_str = stringify.Call(json, {layer_filter}).As<Napi::String>();
-                    auto optional_filter = mbgl::style::conversion::convertJSON<mbgl::style::Filter>(filter_str, filterError);
-                    if (!optional_filter) {
-                        if (filterError.message == "filter property must be a string") {
-                            Napi::TypeError::New(env, "Unable to create Filter object, ensure all filters are expression-based").ThrowAsJavaScriptException();
-
-                        } else {
-                            Napi::TypeError::New(env, filterError.message.c_str()).ThrowAsJavaScriptException();
-                        }
-                        return;
-                    }
-                    filter = *optional_filter;
-                } else if (layer_filter.IsBoolean() && layer_filter.As<Napi::Boolean>()) {
-                    filter = mbgl::style::Filter{};
-                } else {
-                    Napi::TypeError::New(env, "invalid filter value, must be an array or a boolean").ThrowAsJavaScriptException();
-                    return;
-                }
-
-                Napi::Value const layer_properties = layer.Get("properties");
-                if (layer_properties.IsNull() || layer_properties.IsUndefined()) {
-                    Napi::Error::New(env, "Property-Filters is not properly constructed.").ThrowAsJavaScriptException();
+                filter_values_type values;
+                if (!parse_layer(env, filters_obj.Get(layer_key), &values)) {
                     return;
                 }
-
-                // NOTICE: If a layer is styled, but does not have a property, the property value will equal []
-                // NOTICE: If a property is true, that means we need to keep all the properties
-                filter_properties_type property;
-                if (layer_properties.IsArray()) {
-                    auto propertyArray = layer_properties.As<Napi::Array>();
-                    std::uint32_t propertiesLength = propertyArray.Length();
-                    std::vector<std::string> values;
-                    values.reserve(propertiesLength);
-                    for (std::uint32_t index = 0; index < propertiesLength; ++index) {
-                        Napi::Value property_value = propertyArray.Get(index);
-                        std::string value = property_value.As<Napi::String>();
-                        if (!value.empty()) {
-                            values.emplace_back(value);
-                        }
-                    }
-                    property.first = list;
-                    property.second = values;
-                } else if (layer_properties.IsBoolean() && layer_properties.As<Napi::Boolean>()) {
-                    property.first = all;
-                    property.second = {};
-                } else {
-                    Napi::TypeError::New(env, "invalid filter value, must be an array or a boolean").ThrowAsJavaScriptException();
-                    return;
-                }
-                std::string source_layer = layer_key.ToString();
-                add_filter(std::move(source_layer), std::move(filter), std::move(property), minzoom, maxzoom);
+                filters.emplace(layer_key.ToString(), std::move(values));
             }
+            filters_ = std::make_shared<filters_type const>(std::move(filters));
         }
     } catch (std::exception const& ex) {
         Napi::TypeError::New(env, ex.what()).ThrowAsJavaScriptException();
@@ -169,8 +182,130 @@ Napi::Value Filters::layers(Napi::CallbackInfo const& info) {
     Napi::EscapableHandleScope scope(info.Env());
     auto layers = Napi::Array::New(Env());
     std::uint32_t idx = 0;
-    for (auto const& lay : filters) {
+    for (auto const& lay : *filters_) {
         layers.Set(idx++, lay.first);
     }
     return scope.Escape(layers);
 }
+
+/**
+ * Add a source-layer's filter, or replace it if the source-layer already exists.
+ * Shaves that are already running keep using the filters they started with.
+ * @name setLayer
+ * @memberof Filters
+ * @param {String} name - the source-layer name
+ * @param {Object} layer - a single layer object from `shaver.styleToFilters`, with `filters`, `properties`, `minzoom` and `maxzoom`
+ * @example
+ * var filters = new shaver.Filters(shaver.styleToFilters(style));
+ * filters.setLayer('poi_label', {
+ *     filters: ['==', ['get', 'maki'], 'cafe'],
+ *     properties: ['name'],
+ *     minzoom: 14,
+ *     maxzoom: 22
+ * });
+ */
+Napi::Value Filters::setLayer(Napi::CallbackInfo const& info) {
+    Napi::Env env = info.Env();
+    try {
+        if (!info[0].IsString()) {
+            Napi::Error::New(env, "layer name must be a string and cannot be null or undefined").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        // The existing filters are only replaced once the new layer converted successfully
+        filter_values_type values;
+        if (!parse_layer(env, info[1], &values)) {
+            return env.Undefined();
+        }
+        set_filter(info[0].As<Napi::String>(), std::move(values));
+    } catch (std::exception const& ex) {
+        Napi::TypeError::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+/**
+ * Remove a source-layer's filter, so the layer is dropped from shaved tiles.
+ * Shaves that are already running keep using the filters they started with.
+ * @name removeLayer
+ * @memberof Filters
+ * @param {String} name - the source-layer name
+ * @returns {Boolean} whether the source-layer existed
+ * @example
+ * var filters = new shaver.Filters(shaver.styleToFilters(style));
+ * filters.removeLayer('poi_label'); // => true
+ */
+Napi::Value Filters::removeLayer(Napi::CallbackInfo const& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::Error::New(env, "layer name must be a string and cannot be null or undefined").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, remove_filter(info[0].As<Napi::String>()));
+}
+
+/**
+ * Get filter evaluation statistics per source-layer, collected while shaving with `adaptive: true`.
+ * When a layer's filter is a top-level `any` or `all`, like the merged filters from `shaver.styleToFilters`,
+ * its branches are evaluated in the order most likely to decide the result first. This order adapts to the
+ * hit rates below and never changes which features are kept. For `any`, a branch only moves ahead of earlier
+ * branches that cannot fail to evaluate (e.g. `==`, `has`, legacy filters), since mbgl stops at the first failure.
+ * @name stats
+ * @memberof Filters
+ * @returns {Object} per source-layer: `type` ('any', 'all' or 'single'), `evaluations` and `hits` (features evaluated and kept),
+ * `branches` (per branch, in style order: `evaluations`, every time the branch was evaluated, and `hits`, the evaluations that returned true) and `order` (branch indexes in evaluation order)
+ * @example
+ * var filters = new shaver.Filters(shaver.styleToFilters(style));
+ * // ... shave some tiles with `adaptive: true`
+ * console.log(filters.stats());
+ * // {
+ * //   "poi_label": {
+ * //     "type": "any",
+ * //     "evaluations": 120,
+ * //     "hits": 31,
+ * //     "branches": [{ "evaluations": 120, "hits": 2 }, { "evaluations": 118, "hits": 29 }],
+ * //     "order": [1, 0]
+ * //   },
+ * //   ...
+ * // }
+ */
+Napi::Value Filters::stats(Napi::CallbackInfo const& info) {
+    Napi::Env env = info.Env();
+    Napi::EscapableHandleScope scope(env);
+    auto result = Napi::Object::New(env);
+    for (auto const& lay : *filters_) {
+        AdaptiveFilter const& adaptive_filter = *std::get<4>(lay.second);
+        auto layer_stats = Napi::Object::New(env);
+        switch (adaptive_filter.kind()) {
+        case AdaptiveFilter::kind_type::any:
+            layer_stats.Set("type", "any");
+            break;
+        case AdaptiveFilter::kind_type::all:
+            layer_stats.Set("type", "all");
+            break;
+        default:
+            layer_stats.Set("type", "single");
+            break;
+        }
+        layer_stats.Set("evaluations", Napi::Number::New(env, static_cast<double>(adaptive_filter.evaluations())));
+        layer_stats.Set("hits", Napi::Number::New(env, static_cast<double>(adaptive_filter.hits())));
+
+        auto branches = Napi::Array::New(env);
+        std::uint32_t idx = 0;
+        for (auto const& branch : adaptive_filter.branches()) {
+            auto branch_stats = Napi::Object::New(env);
+            branch_stats.Set("evaluations", Napi::Number::New(env, static_cast<double>(branch.evaluations.load(std::memory_order_relaxed))));
+            branch_stats.Set("hits", Napi::Number::New(env, static_cast<double>(branch.hits.load(std::memory_order_relaxed))));
+            branches.Set(idx++, branch_stats);
+        }
+        layer_stats.Set("branches", branches);
+
+        auto order = Napi::Array::New(env);
+        idx = 0;
+        for (auto const branch_idx : adaptive_filter.order()) {
+            order.Set(idx++, Napi::Number::New(env, static_cast<double>(branch_idx)));
+        }
+        layer_stats.Set("order", order);
+        result.Set(lay.first, layer_stats);
+    }
+    return scope.Escape(result);
+}
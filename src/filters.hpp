@@ -1,7 +1,9 @@
 #pragma once
 
+#include "adaptive_filter.hpp"
 #include <map>
 #include <mbgl/style/filter.hpp>
+#include <memory>
 #include <napi.h>
 #include <tuple>
 
@@ -15,8 +17,13 @@ class Filters : public Napi::ObjectWrap<Filters> {
     using filter_properties_type = std::pair<filter_properties_types, std::vector<std::string>>;
     using filter_key_type = std::string; // TODO(danespringmeyer): convert to data_view
     using zoom_type = double;
-    using filter_values_type = std::tuple<filter_value_type, filter_properties_type, zoom_type, zoom_type>;
+    // The AdaptiveFilter wraps the same filter and keeps its evaluation stats
+    using filter_values_type = std::tuple<filter_value_type, filter_properties_type, zoom_type, zoom_type, std::shared_ptr<AdaptiveFilter>>;
     using filters_type = std::map<filter_key_type, filter_values_type>;
+    // An immutable snapshot of the filters. Updates never modify a published map in place,
+    // they copy it and swap in the new one, so shaves running on worker threads keep
+    // whatever snapshot they started with.
+    using filters_ptr = std::shared_ptr<filters_type const>;
 
     // ctor
     static Napi::FunctionReference constructor;
@@ -25,16 +32,36 @@ class Filters : public Napi::ObjectWrap<Filters> {
     explicit Filters(Napi::CallbackInfo const& info);
 
     Napi::Value layers(Napi::CallbackInfo const& info);
+    Napi::Value setLayer(Napi::CallbackInfo const& info);
+    Napi::Value removeLayer(Napi::CallbackInfo const& info);
+    Napi::Value stats(Napi::CallbackInfo const& info);
 
-    void add_filter(filter_key_type&& key, filter_value_type&& filter, filter_properties_type&& properties, zoom_type minzoom, zoom_type maxzoom) {
-        // add a new key/value pair, with the value equaling a tuple 'filter_values_type' defined above
-        filters.emplace(key, std::make_tuple(std::move(filter), std::move(properties), minzoom, maxzoom));
+    void set_filter(filter_key_type const& key, filter_values_type&& values) {
+        // copy-on-write: add or replace the key/value pair in a copy, then publish the copy
+        auto next = std::make_shared<filters_type>(*filters_);
+        (*next)[key] = std::move(values);
+        filters_ = std::move(next);
     }
 
-    auto get_filters() const -> filters_type const& {
-        return filters;
+    bool remove_filter(filter_key_type const& key) {
+        if (filters_->find(key) == filters_->end()) {
+            return false;
+        }
+        auto next = std::make_shared<filters_type>(*filters_);
+        next->erase(key);
+        filters_ = std::move(next);
+        return true;
+    }
+
+    // Only call from the main thread, worker threads must hold on to the returned snapshot
+    auto get_filters() const -> filters_ptr {
+        return filters_;
     }
 
   private:
-    filters_type filters{};
+    // Converts a single layer object from `shaver.styleToFilters` into filter values.
+    // Returns false after throwing a JS exception if the layer is invalid.
+    static bool parse_layer(Napi::Env env, Napi::Value const& layer_val, filter_values_type* filter_values);
+
+    filters_ptr filters_ = std::make_shared<filters_type const>();
 };
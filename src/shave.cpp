@@ -10,6 +10,7 @@
 #include <mbgl/style/conversion/filter.hpp>
 #include <mbgl/style/filter.hpp>
 #include <mbgl/tile/geometry_tile_data.hpp>
+#include <memory>
 
 #include <tuple>
 #include <utility>
@@ -25,14 +26,15 @@ inline Napi::Value CallbackError(Napi::Env env, std::string const& message, Napi
 }
 
 struct QueryData {
-    QueryData(Napi::Buffer<char> const& buffer, float zoom, mbgl::optional<float> maxzoom, bool compress, Filters* filters)
+    QueryData(Napi::Buffer<char> const& buffer, float zoom, mbgl::optional<float> maxzoom, bool compress, bool adaptive, Filters::filters_ptr filters)
         : buffer_ref{Napi::Persistent(buffer)},
           data_{buffer.Data()},
           dataLength_{buffer.Length()},
           zoom_{zoom},
           maxzoom_{std::move(maxzoom)},
           compress_{compress},
-          filters_{filters} {}
+          adaptive_{adaptive},
+          filters_{std::move(filters)} {}
 
     const char* data() const {
         return data_;
@@ -49,8 +51,11 @@ struct QueryData {
     bool compress() const {
         return compress_;
     }
-    Filters* filters() {
-        return filters_;
+    bool adaptive() const {
+        return adaptive_;
+    }
+    Filters::filters_type const& filters() const {
+        return *filters_;
     }
 
   private:
@@ -60,7 +65,10 @@ struct QueryData {
     float zoom_;
     mbgl::optional<float> maxzoom_;
     bool compress_;
-    Filters* filters_;
+    bool adaptive_;
+    // Snapshot taken when shave() was called, so filter updates made while this
+    // tile is being shaved do not affect it
+    Filters::filters_ptr filters_;
 };
 
 // We use a std::vector here over std::map and std::unordered_map
@@ -140,12 +148,17 @@ class VTZeroGeometryTileFeature : public mbgl::GeometryTileFeature {
     }
 };
 
+// Without a filter_pass the filter is evaluated by mbgl directly, in style order
 static auto evaluate(mbgl::style::Filter const& filter,
+                     AdaptiveFilter::Pass* filter_pass,
                      float zoom,
                      mbgl::FeatureType ftype,
                      vtzero::feature const& feature) -> bool {
     VTZeroGeometryTileFeature geomfeature(feature, ftype);
     mbgl::style::expression::EvaluationContext context(zoom, &geomfeature);
+    if (filter_pass != nullptr) {
+        return (*filter_pass)(context);
+    }
     return filter(context);
 }
 
@@ -168,6 +181,7 @@ void filterFeatures(vtzero::tile_builder* finalvt,
                     float zoom,
                     vtzero::layer const& layer,
                     mbgl::style::Filter const& mbgl_filter_obj,
+                    AdaptiveFilter* adaptive_filter,
                     Filters::filter_properties_type const& property_filter) {
     /**
     * TODOs:
@@ -192,6 +206,12 @@ void filterFeatures(vtzero::tile_builder* finalvt,
 
     bool needAllProperties = property_filter_type == Filters::filter_properties_types::all;
 
+    // Evaluation stats for this layer are merged into the shared filter stats once all features are done
+    std::unique_ptr<AdaptiveFilter::Pass> filter_pass;
+    if (adaptive_filter != nullptr) {
+        filter_pass = std::make_unique<AdaptiveFilter::Pass>(adaptive_filter);
+    }
+
     layer.for_each_feature([&](vtzero::feature&& feature) {
         mbgl::FeatureType geometry_type = convertGeom(feature.geometry_type());
 
@@ -201,7 +221,7 @@ void filterFeatures(vtzero::tile_builder* finalvt,
 
         // If evaluate() returns true, this feature includes properties that are relevant to the filter.
         // So we add the feature to the final layer.
-        if (evaluate(mbgl_filter_obj, zoom, geometry_type, feature)) {
+        if (evaluate(mbgl_filter_obj, filter_pass.get(), zoom, geometry_type, feature)) {
             vtzero::geometry_feature_builder feature_builder{layer_builder};
             if (feature.has_id()) {
                 feature_builder.set_id(feature.id());
@@ -249,7 +269,7 @@ struct Shaver : Napi::AsyncWorker {
             vtzero::vector_tile vt{dv}; // Needed for reading the tile
             vtzero::tile_builder finalvt;
 
-            auto const& active_filters = query_data_->filters()->get_filters();
+            auto const& active_filters = query_data_->filters();
             while (auto layer = vt.next_layer()) {
                 // Check if layer is empty (TODO: or invalid)
                 if (layer.empty()) {
@@ -268,6 +288,7 @@ struct Shaver : Napi::AsyncWorker {
                     auto const& property_filter = std::get<1>(filter);
                     auto const minzoom = std::get<2>(filter);
                     auto const maxzoom = std::get<3>(filter);
+                    auto* adaptive_filter = query_data_->adaptive() ? std::get<4>(filter).get() : nullptr;
 
                     // If zoom level is relevant to filter
                     // OR if the style layer minzoom is styling overzoomed tiles...
@@ -280,7 +301,7 @@ struct Shaver : Napi::AsyncWorker {
                             finalvt.add_existing_layer(layer); // Add to new tile
                         } else {
                             // Ampersand in front of var: "Pass as pointers"
-                            filterFeatures(&finalvt, query_data_->zoom(), layer, mbgl_filter_obj, property_filter);
+                            filterFeatures(&finalvt, query_data_->zoom(), layer, mbgl_filter_obj, adaptive_filter, property_filter);
                         }
                     }
                 }
@@ -335,6 +356,8 @@ struct Shaver : Napi::AsyncWorker {
  * @param {Number} [options.maxzoom]
  * @param {Object} [options.compress]
  * @param {String} options.compress.type output a compressed shaved ['none'|'gzip']
+ * @param {Boolean} [options.adaptive=false] evaluate `any`/`all` filter branches in adaptive order and update `Filters.stats`.
+ * Keeps the same features as the default, which evaluates filters in style order.
  * @param {Function} callback - from whence the shaven vector tile comes
  * @example
  * var shaver = require('@mapbox/vtshaver');
@@ -445,6 +468,16 @@ Napi::Value shave(Napi::CallbackInfo const& info) {
         }
     }
 
+    // validate adaptive (OPTIONAL)
+    bool adaptive = false;
+    if (options.Has("adaptive")) {
+        Napi::Value adaptive_val = options.Get("adaptive");
+        if (!adaptive_val.IsBoolean()) {
+            return CallbackError(env, "option 'adaptive' must be a boolean", callback);
+        }
+        adaptive = adaptive_val.As<Napi::Boolean>();
+    }
+
     // `filters` comes in as a shaver.Filters object
     if (options.Has("filters")) {
         Napi::Value filters_val = options.Get("filters");
@@ -466,7 +499,7 @@ Napi::Value shave(Napi::CallbackInfo const& info) {
         }
 
         // set up the query_data to pass into our threadpool
-        auto query_data = std::make_unique<QueryData>(buffer, zoom, maxzoom, compress, Napi::ObjectWrap<Filters>::Unwrap(filters_object));
+        auto query_data = std::make_unique<QueryData>(buffer, zoom, maxzoom, compress, adaptive, Napi::ObjectWrap<Filters>::Unwrap(filters_object)->get_filters());
         auto* worker = new Shaver{std::move(query_data), callback};
         worker->Queue();
         return env.Undefined();
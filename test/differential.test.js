@@ -0,0 +1,326 @@
+'use strict';
+
+// Differential tests: every fast path in shave must keep exactly the same layers, features
+// and properties as the reference path, which evaluates each filter with mbgl in style
+// order (`adaptive: false`). Tiles from test/fixtures and @mapbox/mvt-fixtures are shaved
+// both ways with the styles in test/fixtures/styles and with randomly generated filters.
+//
+// FUZZ_ITERATIONS:  random styles per mvt-fixture (default 5)
+// SEED:             seed for the random styles, printed with the style when a case fails
+// SHOW_COMPARE:     time BENCH_ITERATIONS shaves of each fixture and real-world tile with both
+//                   paths and print the speedup. mvt-fixtures are too small to time.
+// BENCH_ITERATIONS: shaves per path when timing (default 200)
+
+var test = require('tape');
+var Shaver = require('../lib/index.js');
+var fs = require('fs');
+var path = require('path');
+var vt = require('@mapbox/vector-tile').VectorTile;
+var pbf = require('pbf');
+var mvtf = require('@mapbox/mvt-fixtures');
+var d3_queue = require('d3-queue');
+var SHOW_COMPARE = process.env.SHOW_COMPARE;
+var FUZZ_ITERATIONS = parseInt(process.env.FUZZ_ITERATIONS || '5', 10);
+var SEED = parseInt(process.env.SEED || '1', 10);
+var BENCH_ITERATIONS = parseInt(process.env.BENCH_ITERATIONS || '200', 10);
+// same as the default libuv threadpool size, so the threadpool stays busy while timing
+var BENCH_CONCURRENCY = 4;
+// shave the same tile a few times so the adaptive order has stats to work with
+var ROUNDS = 3;
+
+// mulberry32, so a failing case can be reproduced with SEED
+function random(seed) {
+  return function() {
+    seed |= 0; seed = seed + 0x6D2B79F5 | 0;
+    var t = Math.imul(seed ^ seed >>> 15, 1 | seed);
+    t = t + Math.imul(t ^ t >>> 7, 61 | t) ^ t;
+    return ((t ^ t >>> 14) >>> 0) / 4294967296;
+  };
+}
+
+function decode(buffer) {
+  var tile = new vt(new pbf(buffer));
+  var layers = {};
+  Object.keys(tile.layers).forEach(function(name) {
+    var layer = tile.layers[name];
+    var features = [];
+    for (var i = 0; i < layer.length; i++) {
+      var feature = layer.feature(i);
+      features.push({
+        id: feature.id,
+        type: feature.type,
+        properties: feature.properties,
+        geometry: feature.loadGeometry().map(function(ring) {
+          return ring.map(function(point) { return [point.x, point.y]; });
+        })
+      });
+    }
+    layers[name] = { version: layer.version, extent: layer.extent, features: features };
+  });
+  return layers;
+}
+
+function shave(buffer, filters, zoom, adaptive, callback) {
+  Shaver.shave(buffer, { filters: filters, zoom: zoom, adaptive: adaptive }, callback);
+}
+
+// Shave a tile with both paths and compare. `details` is only printed when they differ.
+function compare(t, label, details, buffer, filters, zoom, callback) {
+  var round = 0;
+  (function next() {
+    if (round === ROUNDS) return callback();
+    shave(buffer, filters, zoom, false, function(refErr, refTile) {
+      shave(buffer, filters, zoom, true, function(optErr, optTile) {
+        var same;
+        if (refErr || optErr) {
+          same = Boolean(refErr && optErr && refErr.message === optErr.message);
+        } else {
+          same = refTile.equals(optTile);
+        }
+        t.ok(same, label + ': same result');
+        if (!same) {
+          t.comment(details);
+          if (!refErr && !optErr) {
+            t.deepEqual(decode(optTile), decode(refTile), label + ': same layers, features and properties');
+          } else {
+            t.comment('reference error: ' + (refErr && refErr.message) + ', adaptive error: ' + (optErr && optErr.message));
+          }
+        }
+        round++;
+        next();
+      });
+    });
+  })();
+}
+
+// Time many shaves of the same tile, like bench/bench-batch.js, so the threadpool
+// round trip of a single shave does not dominate
+function benchmark(buffer, filters, zoom, adaptive, callback) {
+  var queue = d3_queue.queue(BENCH_CONCURRENCY);
+  var start = process.hrtime();
+  for (var i = 0; i < BENCH_ITERATIONS; i++) {
+    // errors are checked by compare(), only the time matters here
+    queue.defer(function(cb) {
+      shave(buffer, filters, zoom, adaptive, function() { cb(); });
+    });
+  }
+  queue.awaitAll(function() {
+    var diff = process.hrtime(start);
+    callback((diff[0] * 1e3 + diff[1] / 1e6) / BENCH_ITERATIONS);
+  });
+}
+
+function report(t, label, buffer, filters, zoom, callback) {
+  if (!SHOW_COMPARE) return callback();
+  benchmark(buffer, filters, zoom, false, function(reference) {
+    benchmark(buffer, filters, zoom, true, function(optimized) {
+      t.comment(label + ': reference ' + reference.toFixed(3) + 'ms, adaptive ' + optimized.toFixed(3) +
+        'ms per shave, speedup ' + (reference / optimized).toFixed(2) + 'x');
+      callback();
+    });
+  });
+}
+
+function series(cases, run, callback) {
+  var idx = 0;
+  (function next() {
+    if (idx === cases.length) return callback();
+    run(cases[idx++], next);
+  })();
+}
+
+var stylesDir = path.join(__dirname, 'fixtures/styles');
+var tilesDir = path.join(__dirname, 'fixtures/tiles');
+var styles = fs.readdirSync(stylesDir).map(function(file) {
+  return { name: file, style: JSON.parse(fs.readFileSync(path.join(stylesDir, file))) };
+});
+var tiles = fs.readdirSync(tilesDir).map(function(file) {
+  return { name: file, buffer: fs.readFileSync(path.join(tilesDir, file)) };
+});
+
+function filtersFor(style) {
+  try {
+    return new Shaver.Filters(Shaver.styleToFilters(style));
+  } catch (err) {
+    // styles mixing legacy and expression filters are rejected by both paths
+    return null;
+  }
+}
+
+test('differential: fixture styles on fixture tiles', function(t) {
+  var cases = [];
+  styles.forEach(function(style) {
+    var filters = filtersFor(style.style);
+    if (!filters) return t.comment('skipping ' + style.name + ': not a valid Filters object');
+    tiles.forEach(function(tile) {
+      [0, 14, 16].forEach(function(zoom) {
+        cases.push({ style: style, filters: filters, tile: tile, zoom: zoom });
+      });
+    });
+  });
+  series(cases, function(c, next) {
+    var label = c.style.name + ' ' + c.tile.name + ' z' + c.zoom;
+    compare(t, label, label, c.tile.buffer, c.filters, c.zoom, function() {
+      report(t, label, c.tile.buffer, c.filters, c.zoom, next);
+    });
+  }, function() {
+    t.end();
+  });
+});
+
+test('differential: fixture styles on real-world tiles', function(t) {
+  var realWorld = path.join(path.dirname(require.resolve('@mapbox/mvt-fixtures/package.json')), 'real-world');
+  if (!fs.existsSync(realWorld)) {
+    t.comment('no real-world fixtures found');
+    return t.end();
+  }
+  var cases = [];
+  var realWorldStyles = styles.filter(function(style) {
+    return style.name === 'bright-v9.json' || style.name === 'expressions.json';
+  }).map(function(style) {
+    return { name: style.name, filters: filtersFor(style.style) };
+  }).filter(function(style) {
+    return style.filters;
+  });
+  fs.readdirSync(realWorld).forEach(function(dir) {
+    fs.readdirSync(path.join(realWorld, dir)).forEach(function(file) {
+      // real-world tiles are named z-x-y.mvt
+      var zoom = parseInt(file.split('-')[0], 10);
+      var buffer = fs.readFileSync(path.join(realWorld, dir, file));
+      realWorldStyles.forEach(function(style) {
+        cases.push({ name: dir + '/' + file, style: style, buffer: buffer, zoom: isNaN(zoom) ? 14 : zoom });
+      });
+    });
+  });
+  series(cases, function(c, next) {
+    var label = c.style.name + ' ' + c.name;
+    compare(t, label, label, c.buffer, c.style.filters, c.zoom, function() {
+      report(t, label, c.buffer, c.style.filters, c.zoom, next);
+    });
+  }, function() {
+    t.end();
+  });
+});
+
+// Collect layer names, property keys and values to build filters that actually match
+function describe(buffer) {
+  var layers = {};
+  try {
+    var tile = new vt(new pbf(buffer));
+    Object.keys(tile.layers).forEach(function(name) {
+      var layer = tile.layers[name];
+      var properties = {};
+      for (var i = 0; i < layer.length; i++) {
+        var props = layer.feature(i).properties;
+        Object.keys(props).forEach(function(key) {
+          properties[key] = properties[key] || [];
+          if (properties[key].indexOf(props[key]) === -1) properties[key].push(props[key]);
+        });
+      }
+      layers[name] = properties;
+    });
+  } catch (err) {
+    // invalid fixtures still get shaved, with made up layer names
+  }
+  if (Object.keys(layers).length === 0) {
+    layers.hello = { string_value: ['world'] };
+    layers.layer_name = { string: ['hello'] };
+  }
+  return layers;
+}
+
+function randomStyle(rand, layers) {
+  function pick(list) { return list[Math.floor(rand() * list.length)]; }
+  var layerNames = Object.keys(layers).concat(['not_in_tile']);
+  var legacy = rand() < 0.3;
+
+  function filterFor(properties) {
+    var keys = Object.keys(properties).concat(['missing_key']);
+    function key() { return pick(keys); }
+    function value(k) {
+      var values = properties[k] || [];
+      return values.length && rand() < 0.8 ? pick(values) : pick(['world', 1, 0.5, true, 'nope']);
+    }
+    function number() { return pick([0, 1, 2, 5, 10, 100]); }
+    function geometryType() { return pick(['Point', 'LineString', 'Polygon']); }
+
+    function legacyFilter(depth) {
+      if (depth < 2 && rand() < 0.3) {
+        var branches = [pick(['any', 'all', 'none'])];
+        for (var i = 0, n = 1 + Math.floor(rand() * 4); i < n; i++) branches.push(legacyFilter(depth + 1));
+        return branches;
+      }
+      var k = key();
+      switch (Math.floor(rand() * 6)) {
+      case 0: return ['==', k, value(k)];
+      case 1: return ['!=', k, value(k)];
+      case 2: return [pick(['<', '<=', '>', '>=']), k, number()];
+      case 3: return [pick(['in', '!in']), k, value(k), value(k)];
+      case 4: return [pick(['has', '!has']), k];
+      default: return ['==', '$type', geometryType()];
+      }
+    }
+
+    function expressionFilter(depth) {
+      if (depth < 2 && rand() < 0.3) {
+        var branches = [pick(['any', 'all'])];
+        for (var i = 0, n = 1 + Math.floor(rand() * 4); i < n; i++) branches.push(expressionFilter(depth + 1));
+        return branches;
+      }
+      var k = key();
+      switch (Math.floor(rand() * 8)) {
+      case 0: return ['==', ['get', k], value(k)];
+      case 1: return ['!=', ['get', k], value(k)];
+      // ordering comparisons and coercions fail on some features, exercising the error handling
+      case 2: return [pick(['<', '<=', '>', '>=']), ['get', k], number()];
+      case 3: return ['<', ['to-number', ['get', k]], number()];
+      case 4: return ['has', k];
+      case 5: return ['!', ['has', k]];
+      case 6: return ['match', ['get', k], [String(value(k))], true, false];
+      default: return ['==', ['geometry-type'], geometryType()];
+      }
+    }
+
+    // merged filters from styleToFilters are an `any` of these, so branches vary a lot in selectivity
+    return legacy ? legacyFilter(0) : expressionFilter(0);
+  }
+
+  var styleLayers = [];
+  for (var i = 0, n = 1 + Math.floor(rand() * 8); i < n; i++) {
+    var name = pick(layerNames);
+    var properties = layers[name] || {};
+    var layer = { 'source-layer': name };
+    if (rand() < 0.9) layer.filter = filterFor(properties);
+    if (rand() < 0.3) layer.minzoom = Math.floor(rand() * 16);
+    if (rand() < 0.3) layer.maxzoom = 10 + Math.floor(rand() * 12);
+    var keys = Object.keys(properties);
+    if (keys.length && rand() < 0.5) layer.paint = { 'text-field': ['get', pick(keys)] };
+    styleLayers.push(layer);
+  }
+  return { layers: styleLayers };
+}
+
+test('differential: random filters on mvt-fixtures', function(t) {
+  var rand = random(SEED);
+  var cases = [];
+  var skipped = 0;
+  mvtf.each(function(fixture) {
+    var layers = describe(fixture.buffer);
+    for (var i = 0; i < FUZZ_ITERATIONS; i++) {
+      var style = randomStyle(rand, layers);
+      var filters = filtersFor(style);
+      if (!filters) {
+        skipped++;
+        continue;
+      }
+      cases.push({ fixture: fixture, style: style, filters: filters, zoom: Math.floor(rand() * 17) });
+    }
+  });
+  series(cases, function(c, next) {
+    var details = 'SEED=' + SEED + ' fixture ' + c.fixture.id + ' z' + c.zoom + ' style: ' + JSON.stringify(c.style);
+    compare(t, 'fixture ' + c.fixture.id + ' z' + c.zoom, details, c.fixture.buffer, c.filters, c.zoom, next);
+  }, function() {
+    if (skipped) t.comment(skipped + ' generated styles were not valid Filters objects');
+    t.end();
+  });
+});
@@ -436,6 +436,193 @@ test('success: layers sucessfully shaved, features shaved - equal ==', function(
   });
 });
 
+test('success: Filters.setLayer() adds and replaces a layer, Filters.removeLayer() removes it', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters(style_water));
+  t.deepEqual(filters.layers(), ['water']);
+
+  filters.setLayer('poi_label', Shaver.styleToFilters(style_cafe).poi_label);
+  t.deepEqual(filters.layers(), ['poi_label', 'water'], 'layer added');
+
+  filters.setLayer('water', { filters: ['==', ['get', 'class'], 'nope'], properties: [], minzoom: 0, maxzoom: 22 });
+  t.deepEqual(filters.layers(), ['poi_label', 'water'], 'layer replaced in place');
+
+  t.equals(filters.removeLayer('water'), true, 'existing layer removed');
+  t.equals(filters.removeLayer('water'), false, 'missing layer not removed');
+  t.deepEqual(filters.layers(), ['poi_label']);
+
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16}, function(err, shavedTile) {
+    if (err) throw err;
+    var postTile = vtinfo(shavedTile);
+    t.equals(postTile.layers.length, 1, 'shaved tile contains expected number of layers');
+    t.equals(postTile.layers[0].name, 'poi_label', 'shaved tile contains expected layer');
+    t.equals(postTile.layers[0].features, 1, 'expected number of features after filtering');
+    t.end();
+  });
+});
+
+test('success: Filters updates do not affect shaves already in flight', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters(style_water));
+
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16}, function(err, shavedTile) {
+    if (err) throw err;
+    var postTile = vtinfo(shavedTile);
+    t.equals(postTile.layers.length, 1, 'shaved tile contains expected number of layers');
+    t.equals(postTile.layers[0].name, 'water', 'shaved with the filters from when shave was called');
+
+    Shaver.shave(defaultBuffer, {filters: filters, zoom: 16}, function(err, shavedTile) {
+      if (err) throw err;
+      t.equals(vtinfo(shavedTile).layers.length, 0, 'later shaves use the updated filters');
+      t.end();
+    });
+  });
+  filters.removeLayer('water');
+});
+
+test('success: Filters.stats() reports evaluation counts for merged filters', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters({
+    layers: [
+      { "source-layer": "poi_label", filter: ["==", ["get", "maki"], "cafe"] },
+      { "source-layer": "poi_label", filter: ["<", ["get", "scalerank"], 2] },
+      { "source-layer": "water" }
+    ]
+  }));
+  var poiFeatures = defaultInfo.layers.filter(function(l) { return l.name === 'poi_label'; })[0].features;
+
+  var stats = filters.stats();
+  t.equals(stats.poi_label.type, 'any', 'merged filter is an any expression');
+  t.equals(stats.poi_label.evaluations, 0, 'no evaluations before shaving');
+  t.deepEqual(stats.poi_label.order, [0, 1], 'style order before shaving');
+  t.equals(stats.water.type, 'single', 'unfiltered layer');
+
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err, shavedTile) {
+    if (err) throw err;
+    var kept = vtinfo(shavedTile).layers.filter(function(l) { return l.name === 'poi_label'; })[0].features;
+    var stats = filters.stats();
+    t.equals(stats.poi_label.evaluations, poiFeatures, 'every feature evaluated');
+    t.equals(stats.poi_label.hits, kept, 'hits match the features kept');
+    t.equals(stats.poi_label.branches.length, 2, 'stats per branch');
+    stats.poi_label.branches.forEach(function(branch) {
+      t.ok(branch.hits <= branch.evaluations, 'branch hits bounded by evaluations');
+      t.ok(branch.evaluations <= poiFeatures, 'branch evaluations bounded by features');
+    });
+    t.deepEqual(stats.poi_label.order.slice().sort(), [0, 1], 'order is a permutation of the branches');
+    t.equals(stats.water.evaluations, stats.water.hits, 'unfiltered layer keeps every feature');
+    t.deepEqual(stats.water.branches, [], 'no branches for an unfiltered layer');
+    t.end();
+  });
+});
+
+// poi_label in the fixture tile has 13 features: 10 have a name, 1 of them is a cafe and 7 names sort before 'M'.
+// The `<` branch fails on the 3 features without a name, like mbgl does for ordering comparisons on missing properties.
+function poiFilters(branches) {
+  return new Shaver.Filters({
+    poi_label: { filters: ['any'].concat(branches), properties: ['maki', 'name'], minzoom: 0, maxzoom: 22 }
+  });
+}
+var cafeBranch = ['==', ['get', 'maki'], 'cafe'];
+var nameBranch = ['has', 'name'];
+var fallibleBranch = ['<', ['get', 'name'], 'M'];
+
+function shaveTwice(filters, callback) {
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err) {
+    if (err) throw err;
+    Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, callback);
+  });
+}
+
+test('success: adaptive order moves the branch that decides most features first', function(t) {
+  var filters = poiFilters([cafeBranch, nameBranch, fallibleBranch]);
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err) {
+    if (err) throw err;
+    var stats = filters.stats().poi_label;
+    t.equals(stats.evaluations, 13, 'every feature evaluated');
+    t.equals(stats.hits, 10, 'named features kept');
+    t.deepEqual(stats.branches, [{evaluations: 13, hits: 1}, {evaluations: 12, hits: 9}, {evaluations: 3, hits: 0}], 'style order stats');
+    t.deepEqual(stats.order, [1, 2, 0], 'most frequent match first, the failing branch may move ahead of the infallible cafe branch');
+
+    // the unnamed features now fail the `<` branch before the cafe branch was evaluated
+    Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err) {
+      if (err) throw err;
+      var stats = filters.stats().poi_label;
+      t.deepEqual(stats.branches, [{evaluations: 16, hits: 1}, {evaluations: 25, hits: 19}, {evaluations: 6, hits: 0}], 'cafe branch evaluated for features the `<` branch failed on');
+      t.deepEqual(stats.order, [1, 2, 0], 'the `<` branch still scores above the cafe branch');
+
+      Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err, shavedTile) {
+        if (err) throw err;
+        var stats = filters.stats().poi_label;
+        t.deepEqual(stats.branches[0], {evaluations: 19, hits: 1}, 'cafe branch evaluated for features the `<` branch failed on');
+        t.deepEqual(stats.branches[2], {evaluations: 9, hits: 0}, '`<` branch never matches');
+        t.deepEqual(stats.order, [1, 0, 2], 'the `<` branch sinks behind the cafe branch as its evaluations grow');
+        Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: false}, function(err, referenceTile) {
+          if (err) throw err;
+          t.ok(shavedTile.equals(referenceTile), 'same tile as evaluating in style order');
+          t.equals(vtinfo(shavedTile).layers[0].features, 10, 'expected number of features after filtering');
+          t.end();
+        });
+      });
+    });
+  });
+});
+
+test('success: adaptive order keeps branches behind an earlier branch that can fail', function(t) {
+  var filters = poiFilters([fallibleBranch, cafeBranch, nameBranch]);
+  shaveTwice(filters, function(err, shavedTile) {
+    if (err) throw err;
+    var stats = filters.stats().poi_label;
+    t.deepEqual(stats.branches, [{evaluations: 26, hits: 14}, {evaluations: 3, hits: 0}, {evaluations: 6, hits: 6}], 'stats');
+    t.deepEqual(stats.order, [0, 2, 1], 'the name branch matches more often but cannot move ahead of the `<` branch');
+    Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: false}, function(err, referenceTile) {
+      if (err) throw err;
+      t.ok(shavedTile.equals(referenceTile), 'same tile as evaluating in style order');
+      t.equals(vtinfo(shavedTile).layers[0].features, 10, 'features without a name fail the filter, like in mbgl');
+      t.end();
+    });
+  });
+});
+
+test('failure: Filters.setLayer() with invalid layer keeps existing filters', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters(style_water));
+  try {
+    filters.setLayer('water', { filters: [0], minzoom: 0, maxzoom: 22, properties: true });
+    t.ok(false);
+  } catch (err) {
+    t.equals(err.message, 'filter operator must be a string');
+  }
+  try {
+    filters.setLayer('water', { filters: true, properties: true });
+    t.ok(false);
+  } catch (err) {
+    t.equals(err.message, 'Filter must include a minzoom property.');
+  }
+  try {
+    filters.setLayer('water');
+    t.ok(false);
+  } catch (err) {
+    t.equals(err.message, 'layer must be an object and cannot be null or undefined');
+  }
+  try {
+    filters.setLayer(null, { filters: true, minzoom: 0, maxzoom: 22, properties: true });
+    t.ok(false);
+  } catch (err) {
+    t.equals(err.message, 'layer name must be a string and cannot be null or undefined');
+  }
+  try {
+    filters.removeLayer();
+    t.ok(false);
+  } catch (err) {
+    t.equals(err.message, 'layer name must be a string and cannot be null or undefined');
+  }
+  t.deepEqual(filters.layers(), ['water'], 'filters unchanged');
+
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16}, function(err, shavedTile) {
+    if (err) throw err;
+    var postTile = vtinfo(shavedTile);
+    t.equals(postTile.layers.length, 1, 'shaved tile contains expected number of layers');
+    t.equals(postTile.layers[0].name, 'water', 'shaved tile contains expected layer');
+    t.end();
+  });
+});
+
 test('success: evaluate function returns empty object because no matches', function(t) {
   var sizeBefore = defaultBuffer.length;
   var beforeTile = vtinfo(defaultBuffer);
@@ -815,6 +1002,29 @@ test('failure: Shaver.shave(): invalid VT throws protozero error', function(t) {
   });
 });
 
+test('failure: Shaver.shave(): invalid adaptive option', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters(style_water));
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: 'yes'}, function(err, shavedTile) {
+    t.ok(err);
+    t.equals(err.message, "option 'adaptive' must be a boolean");
+    t.end();
+  });
+});
+
+test('success: Shaver.shave(): adaptive is opt-in and keeps the same features', function(t) {
+  var filters = new Shaver.Filters(Shaver.styleToFilters(style_cafe));
+  Shaver.shave(defaultBuffer, {filters: filters, zoom: 16}, function(err, referenceTile) {
+    if (err) throw err;
+    t.equals(filters.stats().poi_label.evaluations, 0, 'stats not updated by default');
+    Shaver.shave(defaultBuffer, {filters: filters, zoom: 16, adaptive: true}, function(err, shavedTile) {
+      if (err) throw err;
+      t.ok(filters.stats().poi_label.evaluations > 0, 'stats updated');
+      t.ok(shavedTile.equals(referenceTile), 'same tile');
+      t.end();
+    });
+  });
+});
+
 test('failure: Shaver.shave(): invalid filter: null', function(t) {
   Shaver.shave(defaultBuffer, {filters: null, zoom: 5}, function(err, shavedTile) {
     t.ok(err);